@@ -0,0 +1,48 @@
+\
+\   ANS Forth for the Clockwork PicoCalc
+\   Copyright Blair Leduc.
+\   See LICENSE for details.
+\
+\   Utility words, loaded on demand (see Library in interpreter/autoload.S). Each paragraph is
+\   loaded the first time one of the words it defines is used.
+\
+
+: NOOP ( -- ) ;
+
+: BOUNDS ( addr u -- addr+u addr ) OVER + SWAP ;
+
+: UNDER+ ( n1 x n2 -- n1+n2 x ) ROT + SWAP ;
+
+: PERFORM ( a-addr -- ) @ EXECUTE ;
+
+: ON ( a-addr -- ) TRUE SWAP ! ;
+: OFF ( a-addr -- ) 0 SWAP ! ;
+
+: 2NIP ( x1 x2 x3 x4 -- x3 x4 ) 2SWAP 2DROP ;
+
+: 3DUP ( x1 x2 x3 -- x1 x2 x3 x1 x2 x3 ) DUP 2OVER ROT ;
+
+\ 8.6.1.0360 2CONSTANT, 8.6.1.0440 2VARIABLE
+: 2CONSTANT ( x1 x2 "name" -- ) CREATE , , DOES> 2@ ;
+: 2VARIABLE ( "name" -- ) CREATE 0 , 0 , ;
+
+\ 6.1.2170 S>D
+: S>D ( n -- d ) DUP 0< ;
+
+\ 8.6.1.1230 DNEGATE
+: DNEGATE ( d1 -- d2 ) SWAP NEGATE SWAP INVERT OVER 0= - ;
+
+\ 8.6.1.1160 DABS
+: DABS ( d -- ud ) DUP 0< IF DNEGATE THEN ;
+
+\ 8.6.1.1080 D0=, 8.6.1.1120 D=
+: D0= ( xd -- flag ) OR 0= ;
+: D= ( xd1 xd2 -- flag ) ROT = >R = R> AND ;
+
+\ 6.2.1173 DEFER, 6.2.1175 DEFER@, 6.2.1177 DEFER!, 6.2.1725 IS, 6.2.0698 ACTION-OF
+\ (IS and ACTION-OF are interpreted, not compiled)
+: DEFER ( "name" -- ) CREATE ['] NOOP , DOES> @ EXECUTE ;
+: DEFER@ ( xt1 -- xt2 ) >BODY @ ;
+: DEFER! ( xt2 xt1 -- ) >BODY ! ;
+: IS ( xt "name" -- ) ' DEFER! ;
+: ACTION-OF ( "name" -- xt ) ' DEFER@ ;
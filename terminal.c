@@ -25,6 +25,7 @@ static bool (*terminal_key_available)(void) = serial_key_available;
 static int  (*terminal_get_key)(void) = serial_get_key;
 static bool (*terminal_emit_available)(void) = serial_emit_available;
 static void (*terminal_emit)(char ch) = serial_emit;
+static void (*terminal_flow_control)(bool enable) = serial_flow_control;
 
 #endif // PICO_ANS_FORTH_TERMINAL_UART
 
@@ -39,6 +40,7 @@ static bool (*terminal_key_available)(void) = keyboard_key_available;
 static int  (*terminal_get_key)(void) = keyboard_get_key;
 static bool (*terminal_emit_available)(void) = display_emit_available;
 static void (*terminal_emit)(char ch) = display_emit;
+static void (*terminal_flow_control)(bool enable) = NULL; // the keyboard holds keys until polled
 
 #endif // PICO_ANS_FORTH_TERMINAL_PICOCALC
 
@@ -123,3 +125,30 @@ void __emit(char ch)
     }
     terminal_emit(ch);
 }
+
+
+
+//
+// Terminal Flow Control
+//
+
+// Hold back the sender when the input buffer fills, while uploading source
+void __flow_control(bool enable)
+{
+    if (terminal_flow_control)
+    {
+        terminal_flow_control(enable);
+    }
+}
+
+
+
+//
+// Time
+//
+
+// Milliseconds since boot
+unsigned int __milliseconds()
+{
+    return to_ms_since_boot(get_absolute_time());
+}
@@ -17,3 +17,9 @@ int __key();
 bool __emit_available();
 void __emit(char ch);
 
+// Terminal Flow Control (see Upload in wordsets/core/input-output.S)
+void __flow_control(bool enable);
+
+// Time
+unsigned int __milliseconds();
+
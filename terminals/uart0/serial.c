@@ -13,6 +13,9 @@
 // and emit characters. The driver uses a circular buffer to store received characters
 // and an interrupt handler to process incoming data.
 //
+// While source is uploaded, the driver holds back the sender with XON/XOFF before the circular
+// buffer overflows (see serial_flow_control).
+//
 
 #include "pico/stdlib.h"
 #include "hardware/uart.h"
@@ -25,6 +28,14 @@ extern volatile bool user_interrupt;
 static volatile uint8_t rx_buffer[UART_BUFFER_SIZE];
 static volatile uint16_t rx_head = 0;
 static volatile uint16_t rx_tail = 0;
+static volatile bool flow_control = false;
+static volatile bool rx_stopped = false;
+
+// The number of characters in the RX buffer
+static inline uint16_t rx_count()
+{
+    return (rx_head - rx_tail) & (UART_BUFFER_SIZE - 1);
+}
 
 // Interrupt handler for UART RX
 void on_uart_rx()
@@ -39,9 +50,20 @@ void on_uart_rx()
             continue;                   // Skip adding this character to the buffer
         }
         uint16_t next_head = (rx_head + 1) & (UART_BUFFER_SIZE - 1);
+        if (next_head == rx_tail)
+        {
+            continue;                   // The buffer is full, drop the character
+        }
         rx_buffer[rx_head] = ch;
         rx_head = next_head;
     }
+
+    // Stop the sender before the buffer overflows
+    if (flow_control && !rx_stopped && rx_count() >= UART_XOFF_LEVEL)
+    {
+        rx_stopped = true;
+        uart_putc_raw(uart0, UART_XOFF);
+    }
 }
 
 void serial_init()
@@ -85,6 +107,13 @@ int serial_get_key()
         
     uint8_t ch = rx_buffer[rx_tail];
     rx_tail = (rx_tail + 1) & (UART_BUFFER_SIZE - 1);
+
+    // Restart the sender once the buffer has drained
+    if (rx_stopped && rx_count() <= UART_XON_LEVEL)
+    {
+        rx_stopped = false;
+        uart_putc_raw(uart0, UART_XON);
+    }
     return ch;
 }
 
@@ -96,4 +125,14 @@ bool serial_emit_available()
 void serial_emit(char ch)
 {
     uart_putc(uart0, ch);             // Send the character
+}
+
+void serial_flow_control(bool enable)
+{
+    flow_control = enable;
+    if (!enable && rx_stopped)
+    {
+        rx_stopped = false;             // Never leave the sender stopped
+        uart_putc_raw(uart0, UART_XON);
+    }
 }
\ No newline at end of file
@@ -15,10 +15,18 @@
 #define UART_TX             0
 #define UART_RX             1
 
-#define UART_BUFFER_SIZE    256
+#define UART_BUFFER_SIZE    1024
+
+// Flow control (XON/XOFF), when enabled: stop the sender when the RX buffer is 3/4 full and
+// restart it when it has drained to 1/4 full, leaving room for what is already on the wire
+#define UART_XON            0x11
+#define UART_XOFF           0x13
+#define UART_XOFF_LEVEL     (UART_BUFFER_SIZE * 3 / 4)
+#define UART_XON_LEVEL      (UART_BUFFER_SIZE / 4)
 
 void serial_init();
 bool serial_key_available();
 int serial_get_key();
 bool serial_emit_available();
 void serial_emit(char ch);
+void serial_flow_control(bool enable);
@@ -0,0 +1,275 @@
+#!/usr/bin/env python3
+#
+#   ANS Forth for the Clockwork PicoCalc
+#   Copyright Blair Leduc.
+#   See LICENSE for details.
+#
+#   Embed the Forth library in flash, with an index from every name it defines to the span of
+#   source that defines it (see Library in interpreter/autoload.S).
+#
+#   A library file is made of spans separated by blank lines. A span is loaded as a whole the first
+#   time one of the names it defines is used, after the spans that define the library words it
+#   uses. A span that defines no names (a comment) and the comment lines of a span are left out.
+#
+#   The text of each span is followed by its tokens, with the names laid out as search keys and
+#   hashed and the numbers converted (see Pre-tokenized Source in interpreter/autoload.S).
+#
+#   usage: library.py library.S library/*.fs
+#
+
+import os
+import sys
+
+import rom_hash
+
+CB_LENGTH = 31                          # as in forth.S
+
+# The kinds of token records, as in interpreter/autoload.S.
+TOKEN_LINE = 0x80
+TOKEN_END = 0x81
+TOKEN_TEXT = 0x82
+TOKEN_NUMBER = 0x84
+TOKEN_PREFIXED = 1
+TOKEN_DOUBLE = 2
+
+# The words that parse the name of a new definition. A colon definition in the library that uses
+# CREATE is a defining word too.
+DEFINING = {':', 'CREATE', 'VARIABLE', 'CONSTANT', 'VALUE', 'BUFFER:', 'MARKER'}
+
+# The words that parse text up to a delimiter, which is not source.
+PARSING = {'(': ')', '.(': ')', '."': '"', 'S"': '"', 'C"': '"', ',"': '"', 'ABORT"': '"'}
+
+
+def read_spans(path):
+    """The spans of a library file, as lists of lines."""
+    spans, span = [], []
+    with open(path, encoding='latin-1') as f:
+        for line in f:
+            line = line.rstrip()
+            if line:
+                span.append(line)
+            elif span:
+                spans.append(span)
+                span = []
+    if span:
+        spans.append(span)
+    return spans
+
+
+def tokens(span):
+    """The words of a span that are interpreted, without the text of comments and strings."""
+    words = []
+    closing = None
+    for line in span:
+        skip = False
+        for word in line.split():
+            if closing:
+                if word.endswith(closing):
+                    closing = None
+                continue
+            if skip:
+                skip = False
+                continue
+            if word == '\\':
+                words.append(word)
+                break
+            upper = word.upper()
+            words.append(upper)
+            if upper in PARSING:
+                closing = PARSING[upper]
+                continue
+            if upper in ('CHAR', '[CHAR]'):
+                skip = True                 # a character, not a word
+    return words
+
+
+def analyse(spans, path):
+    """The names each span defines and the words it uses."""
+    defining = set(DEFINING)
+    names, uses = [], []
+    for span in spans:
+        words = tokens(span)
+        defined = []
+        compiling = None
+        for i, word in enumerate(words[:-1]):
+            if compiling:
+                if word == ';':
+                    compiling = None
+                elif word == 'CREATE':
+                    defining.add(compiling) # a defining word of the library
+            elif word in defining:
+                name = words[i + 1]
+                if len(name) > CB_LENGTH:
+                    sys.exit('library.py: %s: the name %s is too long' % (path, name))
+                defined.append(name)
+                if word == ':':
+                    compiling = name
+        names.append(defined)
+        uses.append(set(words) - set(defined))
+    return names, uses
+
+
+def fold(word):
+    """A word folded to upper case, as names are stored in the dictionary (a to z only)."""
+    return ''.join(chr(ord(c) - 32) if 'a' <= c <= 'z' else c for c in word)
+
+
+def number(word):
+    """The kind, low and high cells of a word as NUMBER converts it in DECIMAL, or None."""
+    kind, base = TOKEN_NUMBER, 10
+    if len(word) == 3 and word[0] == word[2] == "'":
+        return kind | TOKEN_PREFIXED, ord(word[1]) & 0xFF, 0
+    if word[:1] in ('#', '$', '%'):
+        kind, base = kind | TOKEN_PREFIXED, {'#': 10, '$': 16, '%': 2}[word[0]]
+        word = word[1:]
+    negative = word[:1] == '-'
+    if negative:
+        word = word[1:]
+    cells = 1
+    if word[-1:] == '.':
+        kind, cells, word = kind | TOKEN_DOUBLE, 2, word[:-1]
+    digits = '0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ'[:base]
+    if not word or any(c not in digits for c in word.upper()):
+        return None
+    value = int(word, base)
+    if value >> (32 * cells):
+        return None                     # overflows
+    if negative:
+        value = -value & ((1 << (32 * cells)) - 1)
+    return kind, value & 0xFFFFFFFF, value >> 32
+
+
+def records(lines):
+    """The token records of lines of source, for the assembler, as interpreted by
+    __interpret_tokens: a line record before the tokens of each line, and an end record."""
+    out = []
+    for line in lines:
+        if len(line) > 0xFFFF:
+            sys.exit('library.py: a line is too long: %s...' % line[:40])
+        out.append('    .hword %d' % len(line))
+        out.append('    .byte 0x%02x, 0' % TOKEN_LINE)
+        start = 0
+        while True:
+            while start < len(line) and line[start] == ' ':
+                start += 1                  # only spaces delimit a word, as in WORD
+            if start >= len(line):
+                break
+            end = line.find(' ', start)
+            if end < 0:
+                end = len(line)
+            word = fold(line[start:end])
+            if len(word) > 0xFF:
+                sys.exit('library.py: a word is too long: %s...' % word[:40])
+            converted = number(line[start:end])
+            if converted:
+                kind, low, high = converted
+                out.append('    .hword %d' % start)
+                out.append('    .byte 0x%02x, %d' % (kind, len(word)))
+                out.append('    .word 0x%08x, 0x%08x' % (rom_hash.fnv(word), low)
+                           + (', 0x%08x' % high if kind & TOKEN_DOUBLE else ''))
+            elif len(word) <= CB_LENGTH:
+                out.append('    .hword %d' % start)
+                out.append('    .byte %d' % len(word))
+                out.append('    .ascii %s' % ascii(word))
+                out.append('    .balign 4, 0')
+                out.append('    .word 0x%08x' % rom_hash.fnv(word))
+            else:
+                out.append('    .hword %d' % start)
+                out.append('    .byte 0x%02x, %d' % (TOKEN_TEXT, len(word)))
+            if word == '\\':
+                break                       # the rest of the line is a comment
+            start = end + 1
+            if word in PARSING:             # the text up to the delimiter is not source
+                start = line.find(PARSING[word], start) + 1
+                if start == 0:
+                    break
+    out.append('    .hword 0')
+    out.append('    .byte 0x%02x, 0' % TOKEN_END)
+    return out
+
+
+def ascii(text):
+    """A string for the .ascii directive."""
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"').replace('\n', '\\n') + '"'
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('usage: library.py library.S library.fs ...')
+    spans, names, uses, sources = [], [], [], []
+    for path in sys.argv[2:]:
+        file_spans = read_spans(path)
+        file_names, file_uses = analyse(file_spans, path)
+        for span, defined, used in zip(file_spans, file_names, file_uses):
+            if defined:
+                spans.append(span)
+                names.append(defined)
+                uses.append(used)
+                sources.append(os.path.basename(path))
+
+    index = {}
+    for n, defined in enumerate(names):
+        for name in defined:
+            if name in index and index[name] != n:
+                sys.exit('library.py: %s is defined twice in the library' % name)
+            index[name] = n
+    deps = [sorted({index[word] for word in used if word in index} - {n}) for n, used in enumerate(uses)]
+
+    # A span is loaded after the spans it depends on, so they cannot depend on it.
+    done, path = set(), []
+    def visit(n):
+        if n in path:
+            sys.exit('library.py: %s depend on each other' % ', '.join(names[m][0] for m in path))
+        if n not in done:
+            path.append(n)
+            for m in deps[n]:
+                visit(m)
+            path.pop()
+            done.add(n)
+    for n in range(len(spans)):
+        visit(n)
+
+    out = []
+    out.append('@')
+    out.append('@   Generated by tools/library.py from %s, do not edit.' % ', '.join(sorted(set(sources))))
+    out.append('@')
+    out.append('')
+    out.append('    .global LIBRARY_SPANS')
+    out.append('    .set LIBRARY_SPANS, %d' % len(spans))
+    out.append('')
+    out.append('    .section .rodata')
+    out.append('    .balign 4')
+    out.append('    .global library_spans')
+    out.append('library_spans:')
+    for n in range(len(spans)):
+        out.append('    .word library_span_%d, library_tokens_%d, library_deps_%d' % (n, n, n))
+    out.append('')
+    out.append('    .global library_names')
+    out.append('library_names:')
+    for name, n in sorted(index.items(), key=lambda item: (item[1], item[0])):
+        out.append('    .hword %d' % n)
+        out.append('    .byte %d' % len(name))
+        out.append('    .ascii %s' % ascii(name))
+        out.append('    .balign 4, 0')
+    out.append('    .word 0')
+    out.append('')
+    for n, dep in enumerate(deps):
+        out.append('library_deps_%d:' % n)
+        out.append('    .hword ' + ', '.join(str(d) for d in dep + [0xFFFF]))
+    out.append('')
+    for n, span in enumerate(spans):
+        out.append('    @ %s: %s' % (sources[n], ' '.join(names[n])))
+        out.append('library_span_%d:' % n)
+        lines = [line for line in span if line.split()[0] != '\\']    # a comment line is left out
+        for line in lines:
+            out.append('    .ascii %s' % ascii(line + '\n'))
+        out.append('    .balign 4')
+        out.append('library_tokens_%d:' % n)
+        out.extend(records(lines))
+    out.append('')
+    with open(sys.argv[1], 'w', encoding='latin-1') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,168 @@
+#!/usr/bin/env python3
+#
+#   ANS Forth for the Clockwork PicoCalc
+#   Copyright Blair Leduc.
+#   See LICENSE for details.
+#
+#   Generate the minimal perfect hash and the name filter of the words in flash (see Dictionary
+#   Index in interpreter/interpreters.S).
+#
+#   The names are read from the dictionary macros (defword, defcode, defconst, defvalue and defvar)
+#   in wordsets/dictionary.S, which includes the generated file at its end.
+#
+#   A turnkey image built with TURNKEY_STRIP only has headers for the words named by its
+#   application, given by the turnkey.S generated by tools/turnkey.py.
+#
+#   usage: rom_hash.py wordsets/dictionary.S rom_hash.S [turnkey.S]
+#
+
+import os
+import re
+import sys
+
+FNV_BASIS = 0x811C9DC5
+FNV_PRIME = 0x01000193
+MASK = 0xFFFFFFFF
+NAME_FILTER_BITS = 13                   # as in forth.S
+
+DEFINITION = re.compile(r'^\s*def(word|code|const|value|var)\s+"((?:[^"\\]|\\.)*)"\s*,([^@]*)')
+
+
+def fnv(name):
+    """The hash of a name (the same as __hash_name and __name_key)."""
+    h = ((FNV_BASIS ^ len(name)) * FNV_PRIME) & MASK
+    for c in name.encode('latin-1'):
+        h = ((h ^ c) * FNV_PRIME) & MASK
+    return h
+
+
+def mix(h, d):
+    """The slot of a hash in a bucket with displacement d."""
+    return ((h ^ d) * FNV_PRIME) & MASK
+
+
+def filter_bits(h):
+    """The two bits of a hash in the name filter (the same as __name_filter)."""
+    return h & ((1 << NAME_FILTER_BITS) - 1), h >> (32 - NAME_FILTER_BITS)
+
+
+def name_filter(names):
+    """The name filter of the words in flash, as cells."""
+    cells = [0] * ((1 << NAME_FILTER_BITS) // 32)
+    for name in names:
+        for bit in filter_bits(fnv(name)):
+            cells[bit >> 5] |= 1 << (bit & 31)
+    return cells
+
+
+def decimal_name(name):
+    """Is the name shaped like a decimal number (the same as __decimal_name)?"""
+    return re.fullmatch(r'-?[0-9]+', name) is not None
+
+
+def read_words(path):
+    words = []
+    with open(path, encoding='utf-8') as f:
+        for line in f:
+            m = DEFINITION.match(line)
+            if not m:
+                continue
+            kind, name, rest = m.groups()
+            name = re.sub(r'\\(.)', r'\1', name)
+            args = [a.strip() for a in rest.split(',')]
+            label = args[1] if kind in ('word', 'code') else args[0]
+            words.append((name, label))
+    return words
+
+
+def read_kept(path):
+    """The labels of the words that keep their header in a turnkey image."""
+    with open(path, encoding='latin-1') as f:
+        return set(re.findall(r'^\s*\.set keep_(\w+), 1', f.read(), re.M))
+
+
+def perfect_hash(words):
+    """Hash and displace: returns the displacements of the buckets and the entry of every slot."""
+    n = len(words)
+    buckets = [[] for _ in range(n)]
+    for name, label in words:
+        h = fnv(name)
+        buckets[h % n].append((h, label))
+
+    displacement = [0] * n
+    slots = [None] * n
+    for b in sorted(range(n), key=lambda b: -len(buckets[b])):
+        bucket = buckets[b]
+        if len(bucket) <= 1:
+            break
+        for d in range(1, 0x8000):
+            taken = [mix(h, d) % n for h, _ in bucket]
+            if len(set(taken)) == len(taken) and all(slots[s] is None for s in taken):
+                break
+        else:
+            sys.exit('rom_hash.py: no displacement for bucket %d' % b)
+        displacement[b] = d
+        for s, (_, label) in zip(taken, bucket):
+            slots[s] = label
+
+    free = [s for s in range(n) if slots[s] is None]
+    for b in range(n):
+        if len(buckets[b]) == 1:
+            s = free.pop()
+            displacement[b] = -s - 1            # a bucket of one name goes straight to its slot
+            slots[s] = buckets[b][0][1]
+    return displacement, slots
+
+
+def main():
+    if len(sys.argv) not in (3, 4):
+        sys.exit('usage: rom_hash.py dictionary.S rom_hash.S [turnkey.S]')
+    words = read_words(sys.argv[1])
+    names = [name for name, _ in words]
+    for name in names:
+        if name != name.upper():
+            sys.exit('rom_hash.py: %s must be upper case, names are stored folded' % name)
+    if len(set(names)) != len(names):
+        sys.exit('rom_hash.py: a name is defined twice in flash')
+    if len(sys.argv) == 4:
+        kept = read_kept(sys.argv[3])
+        words = [(name, label) for name, label in words if label in kept]
+        names = [name for name, _ in words]
+    displacement, slots = perfect_hash(words)
+
+    out = []
+    out.append('@')
+    out.append('@   Generated by tools/rom_hash.py from %s, do not edit.' % os.path.basename(sys.argv[1]))
+    out.append('@')
+    out.append('')
+    out.append('    .global ROM_HASH_SIZE')
+    out.append('    .set ROM_HASH_SIZE, %d' % len(words))
+    out.append('')
+    out.append('    .section .rodata')
+    out.append('    .balign 4')
+    out.append('    .global rom_hash_entries')
+    out.append('rom_hash_entries:')
+    for label in slots:
+        out.append('    .word entry_%s' % label)
+    out.append('')
+    out.append('    .global rom_hash_displacements')
+    out.append('rom_hash_displacements:')
+    for i in range(0, len(displacement), 8):
+        out.append('    .hword ' + ', '.join(str(d) for d in displacement[i:i + 8]))
+    out.append('    .balign 4')
+    out.append('')
+    out.append('    .global ROM_DECIMAL_NAMES')
+    out.append('    .set ROM_DECIMAL_NAMES, %d' % sum(decimal_name(name) for name in names))
+    out.append('')
+    out.append('    .global rom_name_filter')
+    out.append('rom_name_filter:')
+    cells = name_filter(names)
+    for i in range(0, len(cells), 8):
+        out.append('    .word ' + ', '.join('0x%08x' % c for c in cells[i:i + 8]))
+    out.append('')
+    with open(sys.argv[2], 'w', encoding='utf-8') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+#
+#   ANS Forth for the Clockwork PicoCalc
+#   Copyright Blair Leduc.
+#   See LICENSE for details.
+#
+#   Shake the tree of a turnkey application: starting from its entry word, follow the names it uses
+#   through the spans of the application and of the library, and embed only the spans it reaches,
+#   each after the spans it uses, with their tokens (see Turnkey in bootstrap.S). A span that
+#   defines no names runs at boot, so it is always kept, with the spans it uses.
+#
+#   The words in flash that the kept spans name are given a keep_label symbol, so that with
+#   TURNKEY_STRIP only they have a header (see header in forth.S and tools/rom_hash.py).
+#
+#   usage: turnkey.py turnkey.S ENTRY wordsets/dictionary.S application.fs ... library/*.fs
+#
+
+import os
+import sys
+
+import library
+import rom_hash
+
+
+def code(span):
+    """The lines of a span that are not comments."""
+    return [line for line in span if line.split()[0] != '\\']
+
+
+def main():
+    if len(sys.argv) < 5:
+        sys.exit('usage: turnkey.py turnkey.S ENTRY dictionary.S application.fs ...')
+    entry = sys.argv[2].upper()
+    spans, sources = [], []
+    for path in sys.argv[4:]:
+        for span in library.read_spans(path):
+            if code(span):
+                spans.append(span)
+                sources.append(os.path.basename(path))
+    names, uses = library.analyse(spans, 'the application')
+
+    index = {}
+    for n, defined in enumerate(names):
+        for name in defined:
+            if name in index and index[name] != n:
+                sys.exit('turnkey.py: %s is defined twice' % name)
+            index[name] = n
+    if entry not in index:
+        sys.exit('turnkey.py: the entry word %s is not defined' % entry)
+    flash = dict(rom_hash.read_words(sys.argv[3]))
+
+    deps = [sorted({index[word] for word in used if word in index} - {n}) for n, used in enumerate(uses)]
+
+    # The spans reached from the entry word, and from the spans that run at boot.
+    kept, path, named = set(), [], set()
+    def visit(n):
+        if n in path:
+            sys.exit('turnkey.py: %s depend on each other' % ', '.join(names[m][0] for m in path))
+        if n in kept:
+            return
+        path.append(n)
+        for m in deps[n]:
+            visit(m)
+        named.update(word for word in uses[n] if word not in index and word in flash)
+        path.pop()
+        kept.add(n)
+    for n in range(len(spans)):
+        if not names[n]:
+            visit(n)
+    visit(index[entry])
+
+    # Each span after the spans it uses, in the order of the sources otherwise.
+    order = []
+    def place(n):
+        if n not in order:
+            for m in deps[n]:
+                place(m)
+            order.append(n)
+    for n in sorted(kept):
+        place(n)
+
+    out = []
+    out.append('@')
+    out.append('@   Generated by tools/turnkey.py from %s, do not edit.' % ', '.join(dict.fromkeys(sources)))
+    out.append('@   %s uses %d of %d spans and names %d of %d words in flash.'
+               % (entry, len(order), len(spans), len(named), len(flash)))
+    out.append('@')
+    out.append('')
+    for name in sorted(named, key=lambda name: flash[name]):
+        out.append('    .set keep_%s, 1' % flash[name])
+    out.append('')
+    out.append('    .section .rodata')
+    out.append('    .balign 4')
+    out.append('    .global turnkey_entry')
+    out.append('turnkey_entry:')
+    out.append('    .byte %d' % len(entry))
+    out.append('    .ascii %s' % library.ascii(entry))
+    out.append('')
+    out.append('    .balign 4')
+    out.append('    .global turnkey_source, turnkey_tokens')
+    out.append('turnkey_source:')
+    for n in order:
+        out.append('    @ %s: %s' % (sources[n], ' '.join(names[n]) or '(runs at boot)'))
+        for line in code(spans[n]):
+            out.append('    .ascii %s' % library.ascii(line + '\n'))
+    out.append('    .balign 4')
+    out.append('turnkey_tokens:')
+    out.extend(library.records([line for n in order for line in code(spans[n])]))
+    out.append('')
+    with open(sys.argv[1], 'w', encoding='latin-1') as f:
+        f.write('\n'.join(out))
+
+
+if __name__ == '__main__':
+    main()